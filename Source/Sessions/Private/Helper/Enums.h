@@ -7,4 +7,16 @@ enum class EMatchType : uint8
 	EMT_CTF UMETA(DisplayName = "Capture the Flag"),
 
 	EMT_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+UENUM(BlueprintType)
+enum class ERehostState : uint8
+{
+	ERS_None UMETA(DisplayName = "None"),
+	ERS_Pending UMETA(DisplayName = "Pending"),
+	ERS_Hosting UMETA(DisplayName = "Hosting"),
+	ERS_Joining UMETA(DisplayName = "Joining"),
+	ERS_Watching UMETA(DisplayName = "Watching"),
+
+	ERS_MAX UMETA(DisplayName = "DefaultMAX")
 };
\ No newline at end of file
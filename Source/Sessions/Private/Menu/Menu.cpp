@@ -34,8 +34,9 @@ bool UMenu::Initialize()
  * @param Connections - The number of connections allowed.
  * @param TypeOfMatch - The type of match being played.
  * @param LobbyPath - The path to the Lobby map.
+ * @param bRehost - Should a client take over our sessions when the host leaves?
  */
-void UMenu::Setup(const int32 Connections, const EMatchType TypeOfMatch, const FString LobbyPath)
+void UMenu::Setup(const int32 Connections, const EMatchType TypeOfMatch, const FString LobbyPath, const bool bRehost)
 {
 	/** set the number of connections */
 	PublicConnections = Connections;
@@ -46,6 +47,9 @@ void UMenu::Setup(const int32 Connections, const EMatchType TypeOfMatch, const F
 	/** set the match type */
 	MatchType = TypeOfMatch;
 
+	/** set whether our sessions can be rehosted */
+	bAllowRehost = bRehost;
+
 	/** add the Menu to the player's viewport */
 	AddToViewport();
 
@@ -146,7 +150,7 @@ void UMenu::HostButtonPressed()
 	if (!SessionsSubsystem) return;
 
 	/** create a session via our Subsystem */
-	SessionsSubsystem->CreateSession(PublicConnections, MatchType);
+	SessionsSubsystem->CreateSession(PublicConnections, MatchType, bAllowRehost);
 }
 #pragma endregion Host Button Press
 
@@ -0,0 +1,33 @@
+// kata.codes
+#include "Rehost/SessionsRehostInfo.h"
+#include "Engine/GameInstance.h"
+#include "Net/UnrealNetwork.h"
+#include "Subsystem/SessionsSubsystem.h"
+
+#pragma region Constructor
+ASessionsRehostInfo::ASessionsRehostInfo()
+{
+	bReplicates = true;
+	bAlwaysRelevant = true;
+}
+#pragma endregion Constructor
+
+#pragma region Replication
+void ASessionsRehostInfo::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ASessionsRehostInfo, Successors);
+}
+
+/**
+ * Called on clients when the successor list changed, hands it to our Subsystem
+ * so it is still around once the host is gone.
+ */
+void ASessionsRehostInfo::OnRep_Successors()
+{
+	if (const UGameInstance* GameInstance = GetGameInstance())
+		if (USessionsSubsystem* SessionsSubsystem = GameInstance->GetSubsystem<USessionsSubsystem>())
+			SessionsSubsystem->CacheRehostSuccessors(Successors);
+}
+#pragma endregion Replication
\ No newline at end of file
@@ -1,8 +1,23 @@
 // kata.codes
 #include "Subsystem/SessionsSubsystem.h"
 #include "Helper/Enums.h"
+#include "IPAddress.h"
+#include "OnlineBeaconHost.h"
 #include "OnlineSessionSettings.h"
 #include "OnlineSubsystem.h"
+#include "PartyBeaconClient.h"
+#include "PartyBeaconHost.h"
+#include "TimerManager.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
 
 #pragma region Constructor
 USessionsSubsystem::USessionsSubsystem() :
@@ -10,7 +25,9 @@ USessionsSubsystem::USessionsSubsystem() :
 	FindSessionsCompleteDelegate(FOnFindSessionsCompleteDelegate::CreateUObject(this, &ThisClass::OnFindSessionsComplete)),
 	JoinSessionCompleteDelegate(FOnJoinSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnJoinSessionComplete)),
 	StartSessionCompleteDelegate(FOnStartSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnStartSessionComplete)),
-	DestroySessionCompleteDelegate(FOnDestroySessionCompleteDelegate::CreateUObject(this, &ThisClass::OnDestroySessionComplete))
+	DestroySessionCompleteDelegate(FOnDestroySessionCompleteDelegate::CreateUObject(this, &ThisClass::OnDestroySessionComplete)),
+	RehostSearchCompleteDelegate(FOnFindSessionsCompleteDelegate::CreateUObject(this, &ThisClass::OnRehostSearchComplete)),
+	FindFriendSessionCompleteDelegate(FOnFindFriendSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnFindFriendSessionComplete))
 {
 	const IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get();
 	if (!Subsystem) return;
@@ -19,6 +36,64 @@ USessionsSubsystem::USessionsSubsystem() :
 }
 #pragma endregion Constructor
 
+#pragma region Subsystem Lifecycle
+/**
+ * Hook the world and login events the party beacon depends on.
+ * @param Collection - The collection this subsystem belongs to.
+ */
+void USessionsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	WorldCleanupDelegateHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &ThisClass::OnWorldCleanup);
+	PostLoadMapDelegateHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ThisClass::OnPostLoadMap);
+	PreLoginDelegateHandle = FGameModeEvents::GameModePreLoginEvent.AddUObject(this, &ThisClass::OnPlayerPreLogin);
+	PostLoginDelegateHandle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &ThisClass::OnPlayerPostLogin);
+	LogoutDelegateHandle = FGameModeEvents::GameModeLogoutEvent.AddUObject(this, &ThisClass::OnPlayerLogout);
+
+	if (GEngine)
+	{
+		NetworkFailureDelegateHandle = GEngine->OnNetworkFailure().AddUObject(this, &ThisClass::OnNetworkFailure);
+		TravelFailureDelegateHandle = GEngine->OnTravelFailure().AddUObject(this, &ThisClass::OnTravelFailure);
+	}
+}
+
+/**
+ * Unhook our events and close any open beacons.
+ */
+void USessionsSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupDelegateHandle);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapDelegateHandle);
+	FGameModeEvents::GameModePreLoginEvent.Remove(PreLoginDelegateHandle);
+	FGameModeEvents::GameModePostLoginEvent.Remove(PostLoginDelegateHandle);
+	FGameModeEvents::GameModeLogoutEvent.Remove(LogoutDelegateHandle);
+
+	if (GEngine)
+	{
+		GEngine->OnNetworkFailure().Remove(NetworkFailureDelegateHandle);
+		GEngine->OnTravelFailure().Remove(TravelFailureDelegateHandle);
+	}
+
+	if (const UGameInstance* GameInstance = GetGameInstance())
+	{
+		GameInstance->GetTimerManager().ClearTimer(RehostTimerHandle);
+		GameInstance->GetTimerManager().ClearTimer(RankSuccessorsTimerHandle);
+	}
+
+	StopPartyBeacon();
+	PartyBeaconState = nullptr;
+
+	if (PartyBeaconClient)
+	{
+		PartyBeaconClient->DestroyBeacon();
+		PartyBeaconClient = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+#pragma endregion Subsystem Lifecycle
+
 #pragma region Session Actions
 
 #pragma region Create Session
@@ -26,16 +101,21 @@ USessionsSubsystem::USessionsSubsystem() :
  * This will create a session with the specified parameters.
  * @param NumPublicConnections - The number of connections allowed.
  * @param MatchType - The type of match being played, in string format.
+ * @param bAllowRehost - Should a client take over the session when we leave?
  */
-void USessionsSubsystem::CreateSession(const int32 NumPublicConnections, const EMatchType MatchType)
+void USessionsSubsystem::CreateSession(const int32 NumPublicConnections, const EMatchType MatchType, const bool bAllowRehost)
 {
 	if (!SessionInterface.IsValid()) return;
 
+	if (RehostState == ERehostState::ERS_Watching)
+		StopWatchingRehost();
+
 	if (const auto ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession); ExistingSession != nullptr)
 	{
 		bCreateSessionOnDestroy = true;
 		LastNumberOfConnections = NumPublicConnections;
 		LastMatchType = MatchType;
+		bLastAllowRehost = bAllowRehost;
 		SessionInterface->DestroySession(NAME_GameSession);
 	}
 
@@ -49,6 +129,7 @@ void USessionsSubsystem::CreateSession(const int32 NumPublicConnections, const E
 	LastSessionSettings->bIsLANMatch = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL" ? true : false;
 	LastSessionSettings->NumPublicConnections = NumPublicConnections;
 	LastSessionSettings->Set(FName("MatchType"), FString(*UEnum::GetValueAsName(MatchType).ToString()), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+	LastSessionSettings->Set(FName("Rehost"), bAllowRehost, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
 	LastSessionSettings->bUsesPresence = true;
 	LastSessionSettings->bAllowJoinViaPresence = true;
 	LastSessionSettings->bAllowJoinInProgress = true;
@@ -56,10 +137,17 @@ void USessionsSubsystem::CreateSession(const int32 NumPublicConnections, const E
 	LastSessionSettings->bUseLobbiesIfAvailable = true;
 	LastSessionSettings->BuildUniqueId = 1;
 
+	/** a new session starts without any party reservations */
+	PartyBeaconState = nullptr;
+	if (StartPartyBeacon(NumPublicConnections))
+		LastSessionSettings->Set(SETTING_BEACONPORT, BeaconHost->GetListenPort(), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+
 	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
 	if (!SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, *LastSessionSettings))
 	{
 		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
+		StopPartyBeacon();
+		PartyBeaconState = nullptr;
 		SessionsOnCreateSessionComplete.Broadcast(false);
 	}
 }
@@ -74,6 +162,12 @@ void USessionsSubsystem::FindSessions(const int32 MaxSearchResults)
 {
 	if (!SessionInterface.IsValid()) return;
 
+	if (!ClaimSessionSearch())
+	{
+		SessionsOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		return;
+	}
+
 	FindSessionsCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
 	LastSessionSearch = MakeShareable(new FOnlineSessionSearch());
 	LastSessionSearch->MaxSearchResults = MaxSearchResults;
@@ -89,6 +183,26 @@ void USessionsSubsystem::FindSessions(const int32 MaxSearchResults)
 }
 #pragma endregion Find Sessions
 
+#pragma region Claim Session Search
+/**
+ * Only one search can run at a time, and every search completes through the same interface event.
+ * This drops the FindSessions binding `CreateSession` leaves behind, so it can't pick up another kind of search.
+ * @return Can a new search start?
+ */
+bool USessionsSubsystem::ClaimSessionSearch()
+{
+	const auto IsSearching = [](const TSharedPtr<FOnlineSessionSearch>& Search)
+	{
+		return Search.IsValid() && Search->SearchState == EOnlineAsyncTaskState::InProgress;
+	};
+
+	if (IsSearching(LastSessionSearch) || IsSearching(RehostSearch)) return false;
+
+	SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+	return true;
+}
+#pragma endregion Claim Session Search
+
 #pragma region Join Session
 /**
  * This will join the specified session.
@@ -113,6 +227,103 @@ void USessionsSubsystem::JoinSession(const FOnlineSessionSearchResult& SessionRe
 }
 #pragma endregion Join Session
 
+#pragma region Join Party Leader Session
+/**
+ * This will follow our party leader into the session it reserved slots on, without searching for it.
+ * Outside the NULL subsystem the session is looked up through the leader's presence, so the leader
+ * has to be a friend and must have joined first. The NULL subsystem has no presence, there we travel
+ * straight to the connect string the leader got with `SessionsOnReservePartySlotsComplete`.
+ * @param PartyLeader - The player that reserved our slot.
+ * @param ConnectString - The address the leader was given for the session, only used on the NULL subsystem.
+ */
+void USessionsSubsystem::JoinPartyLeaderSession(const FUniqueNetIdRepl& PartyLeader, const FString& ConnectString)
+{
+	if (!SessionInterface.IsValid())
+	{
+		SessionsOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+		return;
+	}
+
+	if (IOnlineSubsystem::Get()->GetSubsystemName() == "NULL")
+	{
+		APlayerController* PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
+		if (!PlayerController || ConnectString.IsEmpty())
+		{
+			SessionsOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::CouldNotRetrieveAddress);
+			return;
+		}
+
+		PlayerController->ClientTravel(ConnectString, ETravelType::TRAVEL_Absolute);
+		return;
+	}
+
+	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	if (!LocalPlayer || !PartyLeader.IsValid())
+	{
+		SessionsOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::SessionDoesNotExist);
+		return;
+	}
+
+	const int32 LocalUserNum = LocalPlayer->GetControllerId();
+	FindFriendSessionCompleteDelegateHandle = SessionInterface->AddOnFindFriendSessionCompleteDelegate_Handle(LocalUserNum, FindFriendSessionCompleteDelegate);
+
+	if (!SessionInterface->FindFriendSession(*LocalPlayer->GetPreferredUniqueNetId(), *PartyLeader))
+	{
+		SessionInterface->ClearOnFindFriendSessionCompleteDelegate_Handle(LocalUserNum, FindFriendSessionCompleteDelegateHandle);
+		SessionsOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::SessionDoesNotExist);
+	}
+}
+#pragma endregion Join Party Leader Session
+
+#pragma region Reserve Party Slots
+/**
+ * This will reserve slots for a whole party on the specified session in a single request.
+ * The host holds the reservation for a short time, so members can join via `JoinPartyLeaderSession`
+ * without racing other players for the open connections.
+ * @param SessionResult - The Session to reserve slots on.
+ * @param PartyMembers - The members of the party, the leader is added if missing.
+ */
+void USessionsSubsystem::ReservePartySlots(const FOnlineSessionSearchResult& SessionResult, const TArray<FUniqueNetIdRepl>& PartyMembers)
+{
+	if (PartyBeaconClient)
+	{
+		SessionsOnReservePartySlotsComplete.Broadcast(SessionResult, FString(), EPartyReservationResult::RequestPending);
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	if (!World || !SessionInterface.IsValid())
+	{
+		SessionsOnReservePartySlotsComplete.Broadcast(SessionResult, FString(), EPartyReservationResult::GeneralError);
+		return;
+	}
+
+	const ULocalPlayer* LocalPlayer = World->GetFirstLocalPlayerFromController();
+	const FUniqueNetIdRepl PartyLeader = LocalPlayer->GetPreferredUniqueNetId();
+
+	TArray<FPlayerReservation> Reservations;
+	for (const FUniqueNetIdRepl& MemberId : PartyMembers)
+		Reservations.AddDefaulted_GetRef().UniqueId = MemberId;
+
+	if (!PartyMembers.Contains(PartyLeader))
+		Reservations.AddDefaulted_GetRef().UniqueId = PartyLeader;
+
+	LastReservedSession = SessionResult;
+	PartyBeaconClient = World->SpawnActor<APartyBeaconClient>(APartyBeaconClient::StaticClass());
+	if (!PartyBeaconClient)
+	{
+		SessionsOnReservePartySlotsComplete.Broadcast(SessionResult, FString(), EPartyReservationResult::GeneralError);
+		return;
+	}
+
+	PartyBeaconClient->OnReservationRequestComplete().BindUObject(this, &ThisClass::OnPartyReservationComplete);
+	PartyBeaconClient->OnHostConnectionFailure().BindUObject(this, &ThisClass::OnPartyBeaconHostConnectionFailure);
+
+	if (!PartyBeaconClient->RequestReservation(SessionResult, PartyLeader, Reservations))
+		OnPartyReservationComplete(EPartyReservationResult::GeneralError);
+}
+#pragma endregion Reserve Party Slots
+
 #pragma region Start Session
 /**
  * This will start a new session.
@@ -140,6 +351,11 @@ void USessionsSubsystem::StartSession()
  */
 void USessionsSubsystem::DestroySession()
 {
+	/** leaving on purpose, don't take over the session once the host is gone */
+	RehostSuccessors.Reset();
+	if (RehostState == ERehostState::ERS_Watching)
+		StopWatchingRehost();
+
 	if (!SessionInterface.IsValid())
 	{
 		SessionsOnDestroySessionComplete.Broadcast(false);
@@ -158,6 +374,457 @@ void USessionsSubsystem::DestroySession()
 
 #pragma endregion Session Actions
 
+#pragma region Party Beacon
+
+#pragma region Start Party Beacon
+/**
+ * This will open a party beacon for our session, so party leaders can reserve slots before joining.
+ * Reservations left over from a previous beacon (before map travel) are carried over.
+ * Reservations whose players never arrive expire after the engine's `PartyBeaconHost` `SessionTimeoutSecs`,
+ * a project can shorten it in its own DefaultEngine.ini.
+ * @param NumPublicConnections - The number of connections allowed.
+ * @return Is the beacon accepting reservations?
+ */
+bool USessionsSubsystem::StartPartyBeacon(const int32 NumPublicConnections)
+{
+	StopPartyBeacon();
+
+	UWorld* World = GetWorld();
+	if (!World) return false;
+
+	BeaconHost = World->SpawnActor<AOnlineBeaconHost>(AOnlineBeaconHost::StaticClass());
+	PartyBeaconHost = World->SpawnActor<APartyBeaconHost>(APartyBeaconHost::StaticClass());
+	if (!BeaconHost || !PartyBeaconHost || !BeaconHost->InitHost())
+	{
+		StopPartyBeacon();
+		return false;
+	}
+
+	/** a single team the size of the session, each player may hold one reservation */
+	const bool bInitialized = PartyBeaconState
+		? PartyBeaconHost->InitFromBeaconState(PartyBeaconState)
+		: PartyBeaconHost->InitHostBeacon(1, NumPublicConnections, NumPublicConnections, NAME_GameSession);
+
+	if (!bInitialized)
+	{
+		StopPartyBeacon();
+		return false;
+	}
+
+	PartyBeaconHost->OnValidatePlayers().BindUObject(this, &ThisClass::OnValidatePartyReservation);
+	PartyBeaconHost->OnReservationChanged().BindUObject(this, &ThisClass::UpdateReservedSlots);
+	BeaconHost->RegisterHost(PartyBeaconHost);
+	BeaconHost->PauseBeaconRequests(false);
+	PartyBeaconState = PartyBeaconHost->GetState();
+
+	return true;
+}
+#pragma endregion Start Party Beacon
+
+#pragma region Stop Party Beacon
+/**
+ * This will close the party beacon, the reservations themselves are kept in `PartyBeaconState`.
+ */
+void USessionsSubsystem::StopPartyBeacon()
+{
+	if (BeaconHost)
+	{
+		if (PartyBeaconHost)
+			BeaconHost->UnregisterHost(PartyBeaconHost->GetBeaconType());
+
+		BeaconHost->DestroyBeacon();
+	}
+
+	if (PartyBeaconHost)
+		PartyBeaconHost->Destroy();
+
+	BeaconHost = nullptr;
+	PartyBeaconHost = nullptr;
+}
+#pragma endregion Stop Party Beacon
+
+#pragma region Party Reservation Occupancy
+/**
+ * The connections taken, counting players that joined without a reservation and every reserved slot.
+ * @param Session - The session we are hosting.
+ * @return The number of connections no one else can take.
+ */
+int32 USessionsSubsystem::GetOccupiedConnections(const FNamedOnlineSession& Session) const
+{
+	int32 Occupied = PartyBeaconHost->GetNumConsumedReservations();
+	for (const FUniqueNetIdRef& PlayerId : Session.RegisteredPlayers)
+		if (!PartyBeaconHost->PlayerHasReservation(*PlayerId))
+			++Occupied;
+
+	return Occupied;
+}
+
+/**
+ * The reserved slots whose players have not joined yet.
+ * @param Session - The session we are hosting.
+ * @return The number of slots held for party members still on their way.
+ */
+int32 USessionsSubsystem::GetHeldReservations(const FNamedOnlineSession& Session) const
+{
+	if (!PartyBeaconState) return 0;
+
+	int32 Held = 0;
+	for (const FPartyReservation& Reservation : PartyBeaconState->GetReservations())
+		for (const FPlayerReservation& Member : Reservation.PartyMembers)
+			if (Member.UniqueId.IsValid() && !Session.RegisteredPlayers.ContainsByPredicate(
+				[&Member](const FUniqueNetIdRef& PlayerId) { return *PlayerId == *Member.UniqueId; }))
+				++Held;
+
+	return Held;
+}
+
+/**
+ * This will advertise the held reservations with our session, so searching players
+ * can tell the open connections are spoken for (see `OnFindSessionsComplete`).
+ */
+void USessionsSubsystem::UpdateReservedSlots()
+{
+	if (!SessionInterface.IsValid() || !LastSessionSettings.IsValid()) return;
+
+	const FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
+	if (!Session) return;
+
+	const int32 Held = GetHeldReservations(*Session);
+
+	int32 Advertised = 0;
+	LastSessionSettings->Get(FName("ReservedSlots"), Advertised);
+	if (Advertised == Held) return;
+
+	LastSessionSettings->Set(FName("ReservedSlots"), Held, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+	SessionInterface->UpdateSession(NAME_GameSession, *LastSessionSettings);
+}
+#pragma endregion Party Reservation Occupancy
+
+#pragma endregion Party Beacon
+
+#pragma region Rehost
+
+#pragma region Cache Rehost Successors
+/**
+ * This will remember the host's successor list, so we can take over the session once the host is gone.
+ * @param Successors - The players that can take over, best connection first.
+ */
+void USessionsSubsystem::CacheRehostSuccessors(const TArray<FSessionsSuccessor>& Successors)
+{
+	/** the list we are walking must not change under us */
+	if (RehostState == ERehostState::ERS_Pending || RehostState == ERehostState::ERS_Hosting || RehostState == ERehostState::ERS_Joining) return;
+
+	RehostSuccessors = Successors;
+}
+#pragma endregion Cache Rehost Successors
+
+#pragma region Start Rehost Info
+/**
+ * This will start publishing our successor list to the clients of a session that allows rehosting.
+ * @param World - The World we are listening in.
+ */
+void USessionsSubsystem::StartRehostInfo(UWorld* World)
+{
+	if (!SessionInterface.IsValid() || !SessionInterface->GetNamedSession(NAME_GameSession)) return;
+
+	bool bAllowRehost = false;
+	if (!LastSessionSettings.IsValid() || !LastSessionSettings->Get(FName("Rehost"), bAllowRehost) || !bAllowRehost) return;
+
+	RehostInfo = World->SpawnActor<ASessionsRehostInfo>(ASessionsRehostInfo::StaticClass());
+	if (!RehostInfo) return;
+
+	GetGameInstance()->GetTimerManager().SetTimer(RankSuccessorsTimerHandle, this, &ThisClass::RankSuccessors, RankSuccessorsInterval, true);
+}
+#pragma endregion Start Rehost Info
+
+#pragma region Rank Successors
+/**
+ * This will rank our remote players by their ping to us and publish them as successors.
+ */
+void USessionsSubsystem::RankSuccessors()
+{
+	if (!RehostInfo)
+	{
+		GetGameInstance()->GetTimerManager().ClearTimer(RankSuccessorsTimerHandle);
+		return;
+	}
+
+	const AGameStateBase* GameState = RehostInfo->GetWorld()->GetGameState();
+	if (!GameState) return;
+
+	TArray<const APlayerState*> Candidates;
+	for (const APlayerState* PlayerState : GameState->PlayerArray)
+	{
+		/** only remote players can take over, we are the one leaving */
+		const APlayerController* PlayerController = PlayerState ? Cast<APlayerController>(PlayerState->GetOwner()) : nullptr;
+		if (PlayerController && !PlayerController->IsLocalController() && PlayerController->GetNetConnection() && PlayerState->GetUniqueId().IsValid())
+			Candidates.Add(PlayerState);
+	}
+
+	Candidates.Sort([](const APlayerState& A, const APlayerState& B) { return A.GetPingInMilliseconds() < B.GetPingInMilliseconds(); });
+
+	/** addresses are only needed to reach a successor on the NULL subsystem, don't share them otherwise */
+	const bool bShareAddress = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL";
+
+	/** every successor gets its own port past ours, so two of them on one machine can't collide */
+	const UNetDriver* NetDriver = RehostInfo->GetWorld()->GetNetDriver();
+	const TSharedPtr<const FInternetAddr> LocalAddr = NetDriver ? NetDriver->GetLocalAddr() : nullptr;
+	const int32 ListenPort = LocalAddr.IsValid() ? LocalAddr->GetPort() : 0;
+
+	TArray<FSessionsSuccessor> Successors;
+	for (const APlayerState* PlayerState : Candidates)
+	{
+		FSessionsSuccessor& Successor = Successors.AddDefaulted_GetRef();
+		Successor.PlayerId = PlayerState->GetUniqueId();
+
+		if (bShareAddress && ListenPort > 0)
+		{
+			Successor.Address = Cast<APlayerController>(PlayerState->GetOwner())->GetNetConnection()->LowLevelGetRemoteAddress(false);
+			Successor.Port = ListenPort + Successors.Num();
+		}
+	}
+
+	RehostInfo->Successors = MoveTemp(Successors);
+}
+#pragma endregion Rank Successors
+
+#pragma region Continue Rehost
+/**
+ * This will make the next attempt at getting back into a session after the host left.
+ * Every client walks the same successor list, so whoever reaches their own entry becomes the new host.
+ */
+void USessionsSubsystem::ContinueRehost()
+{
+	if (RehostState != ERehostState::ERS_Pending) return;
+
+	UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client)
+	{
+		/** still tearing down the connection to the departed host, but not for longer than a successor would get */
+		if (FPlatformTime::Seconds() - RehostCandidateStartTime >= RehostCandidateTimeout)
+			FinishRehost(false);
+		else
+			GetGameInstance()->GetTimerManager().SetTimer(RehostTimerHandle, this, &ThisClass::ContinueRehost, RehostRetryDelay, false);
+		return;
+	}
+
+	if (!SessionInterface.IsValid() || !RehostSuccessors.IsValidIndex(RehostCandidate))
+	{
+		FinishRehost(false);
+		return;
+	}
+
+	if (SessionInterface->GetNamedSession(NAME_GameSession))
+	{
+		/** drop the departed host's session first, OnDestroySessionComplete brings us back here */
+		DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate);
+
+		if (!SessionInterface->DestroySession(NAME_GameSession))
+		{
+			SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
+			FinishRehost(false);
+		}
+		return;
+	}
+
+	const ULocalPlayer* LocalPlayer = World->GetFirstLocalPlayerFromController();
+	const bool bIsCandidate = LocalPlayer && LocalPlayer->GetPreferredUniqueNetId() == RehostSuccessors[RehostCandidate].PlayerId;
+
+	/** on the NULL subsystem we know where the candidate listens, searching the LAN would only slow us down */
+	if (IOnlineSubsystem::Get()->GetSubsystemName() == "NULL")
+	{
+		if (bIsCandidate)
+			HostRehostedSession();
+		else
+			TravelToRehostedSession();
+		return;
+	}
+
+	/** the first successor has no one to defer to, everyone else looks for an earlier successor's session first */
+	if (RehostCandidate == 0 && bIsCandidate)
+		HostRehostedSession();
+	else
+		SearchRehostedSession();
+}
+#pragma endregion Continue Rehost
+
+#pragma region Host Rehosted Session
+/**
+ * This will recreate the departed host's session with its original settings, we are the new host.
+ * The session is only tagged with `RehostKey` once we are listening (see `OnPostLoadMap`).
+ */
+void USessionsSubsystem::HostRehostedSession()
+{
+	RehostState = ERehostState::ERS_Hosting;
+	CreateSessionCompleteDelegateHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate);
+
+	/** these describe the departed host, our own beacon and reservations are advertised anew */
+	LastSessionSettings->Remove(FName("RehostKey"));
+	LastSessionSettings->Remove(FName("ReservedSlots"));
+	LastSessionSettings->Remove(SETTING_BEACONPORT);
+
+	PartyBeaconState = nullptr;
+	if (StartPartyBeacon(LastSessionSettings->NumPublicConnections))
+		LastSessionSettings->Set(SETTING_BEACONPORT, BeaconHost->GetListenPort(), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+
+	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	if (!SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, *LastSessionSettings))
+	{
+		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
+		StopPartyBeacon();
+		FailRehostAttempt(true);
+	}
+}
+#pragma endregion Host Rehosted Session
+
+#pragma region Search Rehosted Session
+/**
+ * This will start looking for sessions recreated by a successor, `OnRehostSearchComplete` picks from the results.
+ * Only sessions tagged with the departed session's id as `RehostKey` match, so this needs no friendship
+ * and no browsing of other sessions.
+ * @return Did the search start?
+ */
+bool USessionsSubsystem::StartRehostSearch()
+{
+	const UWorld* World = GetWorld();
+	const ULocalPlayer* LocalPlayer = World ? World->GetFirstLocalPlayerFromController() : nullptr;
+	if (!LocalPlayer || !SessionInterface.IsValid() || !ClaimSessionSearch()) return false;
+
+	RehostSearchCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(RehostSearchCompleteDelegate);
+	RehostSearch = MakeShareable(new FOnlineSessionSearch());
+	RehostSearch->MaxSearchResults = 100;
+	RehostSearch->bIsLanQuery = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL" ? true : false;
+	RehostSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
+	if (!RehostKey.IsEmpty())
+		RehostSearch->QuerySettings.Set(FName("RehostKey"), RehostKey, EOnlineComparisonOp::Equals);
+
+	if (!SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(), RehostSearch.ToSharedRef()))
+	{
+		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(RehostSearchCompleteDelegateHandle);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * This will look up the session recreated by a successor and join it.
+ */
+void USessionsSubsystem::SearchRehostedSession()
+{
+	RehostState = ERehostState::ERS_Joining;
+
+	if (!StartRehostSearch())
+		FailRehostAttempt(false);
+}
+#pragma endregion Search Rehosted Session
+
+#pragma region Travel To Rehosted Session
+/**
+ * This will connect straight to the current candidate, on the port the departed host handed it.
+ * The connection keeps knocking until the candidate listens, a failure counts as a failed attempt.
+ */
+void USessionsSubsystem::TravelToRehostedSession()
+{
+	RehostState = ERehostState::ERS_Joining;
+
+	const FSessionsSuccessor& Successor = RehostSuccessors[RehostCandidate];
+	APlayerController* PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
+	if (!PlayerController || Successor.Address.IsEmpty() || Successor.Port <= 0)
+	{
+		FailRehostAttempt(true);
+		return;
+	}
+
+	PlayerController->ClientTravel(FString::Printf(TEXT("%s:%d"), *Successor.Address, Successor.Port), ETravelType::TRAVEL_Absolute);
+}
+#pragma endregion Travel To Rehosted Session
+
+#pragma region Fail Rehost Attempt
+/**
+ * This will retry the current successor after a short delay, or move on to the next one
+ * once it had `RehostCandidateTimeout` seconds to recreate the session.
+ * Calling this more than once for the same failure only restarts the retry delay.
+ * @param bSkipCandidate - Give up on the current successor right away?
+ */
+void USessionsSubsystem::FailRehostAttempt(const bool bSkipCandidate)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (bSkipCandidate || Now - RehostCandidateStartTime >= RehostCandidateTimeout)
+	{
+		++RehostCandidate;
+		RehostCandidateStartTime = Now;
+	}
+
+	RehostState = ERehostState::ERS_Pending;
+	GetGameInstance()->GetTimerManager().SetTimer(RehostTimerHandle, this, &ThisClass::ContinueRehost, RehostRetryDelay, false);
+}
+#pragma endregion Fail Rehost Attempt
+
+#pragma region Finish Rehost
+/**
+ * This will end the rehost and let listeners know how it went.
+ * Settling on a later successor means an earlier one timed out on our clock only, so we keep watching for it.
+ * @param bWasSuccessful - Are we back in a session?
+ */
+void USessionsSubsystem::FinishRehost(const bool bWasSuccessful)
+{
+	GetGameInstance()->GetTimerManager().ClearTimer(RehostTimerHandle);
+
+	if (bWasSuccessful && RehostCandidate > 0)
+	{
+		RehostState = ERehostState::ERS_Watching;
+		WatchedSuccessors = RehostSuccessors;
+		RehostCandidateStartTime = FPlatformTime::Seconds();
+		GetGameInstance()->GetTimerManager().SetTimer(RehostTimerHandle, this, &ThisClass::WatchRehost, RehostWatchInterval, false);
+	}
+	else
+	{
+		RehostState = ERehostState::ERS_None;
+		RehostCandidate = 0;
+	}
+
+	SessionsOnRehostSessionComplete.Broadcast(bWasSuccessful);
+}
+#pragma endregion Finish Rehost
+
+#pragma region Watch Rehost
+/**
+ * This will look for an earlier successor's session for `RehostCandidateTimeout` seconds after the rehost.
+ * Only whoever hosts searches, it hands its players over once one shows up (see `OnRehostSearchComplete`),
+ * its players then walk the successor list again (see `OnNetworkFailure`).
+ */
+void USessionsSubsystem::WatchRehost()
+{
+	if (RehostState != ERehostState::ERS_Watching) return;
+
+	if (FPlatformTime::Seconds() - RehostCandidateStartTime >= RehostCandidateTimeout)
+	{
+		StopWatchingRehost();
+		return;
+	}
+
+	const UWorld* World = GetWorld();
+	if (World && World->GetNetMode() == NM_ListenServer && StartRehostSearch()) return;
+
+	GetGameInstance()->GetTimerManager().SetTimer(RehostTimerHandle, this, &ThisClass::WatchRehost, RehostWatchInterval, false);
+}
+
+/**
+ * This will stop watching, the session we are in is the one everyone ended up in.
+ */
+void USessionsSubsystem::StopWatchingRehost()
+{
+	GetGameInstance()->GetTimerManager().ClearTimer(RehostTimerHandle);
+
+	RehostState = ERehostState::ERS_None;
+	RehostCandidate = 0;
+	WatchedSuccessors.Reset();
+}
+#pragma endregion Watch Rehost
+
+#pragma endregion Rehost
+
 #pragma region Session Action Complete Delegates
 
 #pragma region On Create Session Complete
@@ -171,6 +838,21 @@ void USessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuc
 	if (SessionInterface)
 		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
 
+	if (RehostState == ERehostState::ERS_Hosting)
+	{
+		if (!bWasSuccessful)
+		{
+			StopPartyBeacon();
+			FailRehostAttempt(true);
+			return;
+		}
+
+		/** load the map the departed host was running, we start listening once it is up (see `OnPostLoadMap`) */
+		if (UWorld* World = GetWorld())
+			World->ServerTravel(RehostMapPath);
+		return;
+	}
+
 	SessionsOnCreateSessionComplete.Broadcast(true);
 }
 #pragma endregion On Create Session Complete
@@ -185,13 +867,28 @@ void USessionsSubsystem::OnFindSessionsComplete(const bool bWasSuccessful)
 	if (SessionInterface)
 		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
 
-	if (LastSessionSearch->SearchResults.Num() <= 0)
+	if (!LastSessionSearch.IsValid())
 	{
 		SessionsOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
 		return;
 	}
 
-	SessionsOnFindSessionsComplete.Broadcast(LastSessionSearch->SearchResults, bWasSuccessful);
+	/** skip sessions whose open connections are all held for party members */
+	TArray<FOnlineSessionSearchResult> SessionResults = LastSessionSearch->SearchResults;
+	SessionResults.RemoveAll([](const FOnlineSessionSearchResult& Result)
+	{
+		int32 ReservedSlots = 0;
+		Result.Session.SessionSettings.Get(FName("ReservedSlots"), ReservedSlots);
+		return ReservedSlots > 0 && Result.Session.NumOpenPublicConnections <= ReservedSlots;
+	});
+
+	if (SessionResults.Num() <= 0)
+	{
+		SessionsOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		return;
+	}
+
+	SessionsOnFindSessionsComplete.Broadcast(SessionResults, bWasSuccessful);
 }
 #pragma endregion On Find Sessions Complete
 
@@ -206,6 +903,34 @@ void USessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSession
 	if (SessionInterface)
 		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
 
+	if (Result == EOnJoinSessionCompleteResult::Success && SessionInterface)
+	{
+		/** a new session, the successors of the one we left no longer apply */
+		if (RehostState == ERehostState::ERS_Watching)
+			StopWatchingRehost();
+		if (RehostState == ERehostState::ERS_None)
+			RehostSuccessors.Reset();
+
+		if (const FOnlineSessionSettings* Settings = SessionInterface->GetSessionSettings(NAME_GameSession))
+			/** keep the host's settings, we need them to recreate the session if we become the new host */
+			LastSessionSettings = MakeShared<FOnlineSessionSettings>(*Settings);
+	}
+
+	if (RehostState == ERehostState::ERS_Joining)
+	{
+		FString Address;
+		APlayerController* PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
+
+		if (Result != EOnJoinSessionCompleteResult::Success || !PlayerController || !SessionInterface->GetResolvedConnectString(NAME_GameSession, Address))
+		{
+			FailRehostAttempt(false);
+			return;
+		}
+
+		PlayerController->ClientTravel(Address, ETravelType::TRAVEL_Absolute);
+		return;
+	}
+
 	SessionsOnJoinSessionComplete.Broadcast(Result);
 }
 #pragma endregion On Join Session Complete
@@ -236,14 +961,400 @@ void USessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSu
 	if (SessionInterface)
 		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
 
+	if (bWasSuccessful)
+	{
+		/** the reservations died with the session */
+		StopPartyBeacon();
+		PartyBeaconState = nullptr;
+	}
+
 	if (bWasSuccessful && bCreateSessionOnDestroy)
 	{
 		bCreateSessionOnDestroy = false;
-		CreateSession(LastNumberOfConnections, LastMatchType);
+		CreateSession(LastNumberOfConnections, LastMatchType, bLastAllowRehost);
+	}
+
+	if (RehostState == ERehostState::ERS_Pending)
+	{
+		if (bWasSuccessful)
+			ContinueRehost();
+		else
+			FinishRehost(false);
 	}
 
 	SessionsOnDestroySessionComplete.Broadcast(bWasSuccessful);
 }
 #pragma endregion On Destroy Session Complete
 
-#pragma endregion Session Action Complete Delegates
\ No newline at end of file
+#pragma region On Find Friend Session Complete
+/**
+ * Called after our party leader's session was looked up through its presence.
+ * @param LocalUserNum - The local user that searched.
+ * @param bWasSuccessful - Was the session found?
+ * @param FriendSearchResults - The sessions the leader is in.
+ */
+void USessionsSubsystem::OnFindFriendSessionComplete(const int32 LocalUserNum, const bool bWasSuccessful, const TArray<FOnlineSessionSearchResult>& FriendSearchResults)
+{
+	if (SessionInterface)
+		SessionInterface->ClearOnFindFriendSessionCompleteDelegate_Handle(LocalUserNum, FindFriendSessionCompleteDelegateHandle);
+
+	if (!bWasSuccessful || FriendSearchResults.Num() <= 0 || !FriendSearchResults[0].IsValid())
+	{
+		SessionsOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::SessionDoesNotExist);
+		return;
+	}
+
+	JoinSession(FriendSearchResults[0]);
+}
+#pragma endregion On Find Friend Session Complete
+
+#pragma region On Rehost Search Complete
+/**
+ * Called after looking for a session recreated by a successor. The earliest successor that
+ * recreated it wins, so clients converge on one session even if a later successor also hosted.
+ * A later successor that is hosting hands its players over to the earlier one's session.
+ * @param bWasSuccessful - Did the search succeed?
+ */
+void USessionsSubsystem::OnRehostSearchComplete(const bool bWasSuccessful)
+{
+	if (SessionInterface)
+		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(RehostSearchCompleteDelegateHandle);
+
+	if ((RehostState != ERehostState::ERS_Joining && RehostState != ERehostState::ERS_Watching) || !RehostSearch.IsValid()) return;
+
+	const TArray<FSessionsSuccessor>& Successors = RehostState == ERehostState::ERS_Watching ? WatchedSuccessors : RehostSuccessors;
+	const FOnlineSessionSearchResult* RehostedSession = nullptr;
+	int32 RehostedIndex = INDEX_NONE;
+
+	for (const FOnlineSessionSearchResult& Result : RehostSearch->SearchResults)
+	{
+		/** LAN queries don't filter on QuerySettings, so check the key ourselves; without a key the owner alone decides */
+		FString Key;
+		Result.Session.SessionSettings.Get(FName("RehostKey"), Key);
+		if (!RehostKey.IsEmpty() && Key != RehostKey) continue;
+
+		const FUniqueNetIdRepl OwnerId(Result.Session.OwningUserId);
+		const int32 Index = Successors.IndexOfByPredicate([&OwnerId](const FSessionsSuccessor& Successor) { return Successor.PlayerId == OwnerId; });
+
+		if (Index != INDEX_NONE && (RehostedIndex == INDEX_NONE || Index < RehostedIndex))
+		{
+			RehostedSession = &Result;
+			RehostedIndex = Index;
+		}
+	}
+
+	if (RehostState == ERehostState::ERS_Watching)
+	{
+		if (RehostedSession && RehostedIndex < RehostCandidate)
+		{
+			/** an earlier successor made it after all, leave our session and follow it there */
+			RehostSuccessors = WatchedSuccessors;
+			RehostCandidate = RehostedIndex;
+			RehostCandidateStartTime = FPlatformTime::Seconds();
+			RehostState = ERehostState::ERS_Pending;
+			ContinueRehost();
+			return;
+		}
+
+		GetGameInstance()->GetTimerManager().SetTimer(RehostTimerHandle, this, &ThisClass::WatchRehost, RehostWatchInterval, false);
+		return;
+	}
+
+	if (RehostedSession)
+	{
+		RehostCandidate = RehostedIndex;
+		JoinSession(*RehostedSession);
+		return;
+	}
+
+	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	if (LocalPlayer && RehostSuccessors.IsValidIndex(RehostCandidate) && LocalPlayer->GetPreferredUniqueNetId() == RehostSuccessors[RehostCandidate].PlayerId)
+	{
+		/** every earlier successor had its chance, it's our turn */
+		HostRehostedSession();
+		return;
+	}
+
+	/** the successor may not have recreated the session yet */
+	FailRehostAttempt(false);
+}
+#pragma endregion On Rehost Search Complete
+
+#pragma endregion Session Action Complete Delegates
+
+#pragma region Party Beacon Delegates
+
+#pragma region On Party Reservation Complete
+/**
+ * Called after the host answered our party reservation request.
+ * @param Result - The result of the reservation request.
+ */
+void USessionsSubsystem::OnPartyReservationComplete(const EPartyReservationResult::Type Result)
+{
+	if (PartyBeaconClient)
+	{
+		PartyBeaconClient->DestroyBeacon();
+		PartyBeaconClient = nullptr;
+	}
+
+	/** members on the NULL subsystem can't find the session through our presence, hand them its address */
+	FString ConnectString;
+	if (Result == EPartyReservationResult::ReservationAccepted && SessionInterface.IsValid())
+		SessionInterface->GetResolvedConnectString(LastReservedSession, NAME_GamePort, ConnectString);
+
+	SessionsOnReservePartySlotsComplete.Broadcast(LastReservedSession, ConnectString, Result);
+}
+
+/**
+ * Called when the host's party beacon could not be reached.
+ */
+void USessionsSubsystem::OnPartyBeaconHostConnectionFailure()
+{
+	OnPartyReservationComplete(EPartyReservationResult::GeneralError);
+}
+#pragma endregion On Party Reservation Complete
+
+#pragma region On Validate Party Reservation
+/**
+ * Called on the host before a party reservation is accepted.
+ * Players that joined without a reservation still occupy a connection, so they are counted too.
+ * @param PartyMembers - The players asking for a slot.
+ * @return Is there room for the whole party?
+ */
+bool USessionsSubsystem::OnValidatePartyReservation(const TArray<FPlayerReservation>& PartyMembers) const
+{
+	if (!SessionInterface.IsValid() || !PartyBeaconHost) return false;
+
+	const FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
+	if (!Session) return false;
+
+	return GetOccupiedConnections(*Session) + PartyMembers.Num() <= Session->SessionSettings.NumPublicConnections;
+}
+#pragma endregion On Validate Party Reservation
+
+#pragma endregion Party Beacon Delegates
+
+#pragma region World Delegates
+
+#pragma region On World Cleanup
+/**
+ * Called when a world is torn down, i.e. when the host travels to the Lobby.
+ * The beacon and successor list actors go with the world; the reservations stay in `PartyBeaconState`.
+ * A reservation request still in flight from this world is reported as canceled.
+ * @param World - The World being cleaned up.
+ * @param bSessionEnded - Is the play session over?
+ * @param bCleanupResources - Are resources being released?
+ */
+void USessionsSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	if (BeaconHost && BeaconHost->GetWorld() == World)
+		StopPartyBeacon();
+
+	if (PartyBeaconClient && PartyBeaconClient->GetWorld() == World)
+		/** the request dies with the world, report it instead of leaving it pending */
+		OnPartyReservationComplete(EPartyReservationResult::ReservationRequestCanceled);
+
+	if (RehostInfo && RehostInfo->GetWorld() == World)
+	{
+		GetGameInstance()->GetTimerManager().ClearTimer(RankSuccessorsTimerHandle);
+		RehostInfo = nullptr;
+	}
+}
+#pragma endregion On World Cleanup
+
+#pragma region On Post Load Map
+/**
+ * Called after a map was loaded, starts listening as the new host or completes a rehost once we are back
+ * in a networked map, and reopens the party beacon and successor list of a session we are still hosting.
+ * @param World - The World that was loaded.
+ */
+void USessionsSubsystem::OnPostLoadMap(UWorld* World)
+{
+	if (!World || World->GetGameInstance() != GetGameInstance()) return;
+
+	if (RehostState == ERehostState::ERS_Hosting && World->GetNetMode() == NM_Standalone && SessionInterface.IsValid())
+	{
+		/** on the NULL subsystem the other clients head for the port the departed host handed us, elsewhere any port will do */
+		const int32 Port = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL" && RehostSuccessors.IsValidIndex(RehostCandidate)
+			? RehostSuccessors[RehostCandidate].Port
+			: 0;
+
+		const UNetDriver* NetDriver = GetGameInstance()->EnableListenServer(true, Port) ? World->GetNetDriver() : nullptr;
+		const TSharedPtr<const FInternetAddr> LocalAddr = NetDriver ? NetDriver->GetLocalAddr() : nullptr;
+
+		if (!LocalAddr.IsValid() || (Port > 0 && LocalAddr->GetPort() != Port))
+		{
+			/** the net driver fell back to another port, nobody would find us there; let the next successor take over */
+			GetGameInstance()->EnableListenServer(false);
+			FailRehostAttempt(true);
+		}
+		else
+		{
+			/** we are listening, let the other clients find us */
+			if (!RehostKey.IsEmpty())
+			{
+				LastSessionSettings->Set(FName("RehostKey"), RehostKey, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+				SessionInterface->UpdateSession(NAME_GameSession, *LastSessionSettings);
+			}
+			FinishRehost(true);
+		}
+	}
+
+	if (RehostState == ERehostState::ERS_Joining && World->GetNetMode() == NM_Client)
+		FinishRehost(true);
+
+	if (World->GetNetMode() == NM_ListenServer)
+		StartRehostInfo(World);
+
+	if (!PartyBeaconState || !SessionInterface.IsValid() || !LastSessionSettings.IsValid()) return;
+
+	if (!SessionInterface->GetNamedSession(NAME_GameSession))
+	{
+		PartyBeaconState = nullptr;
+		return;
+	}
+
+	if (!StartPartyBeacon(LastSessionSettings->NumPublicConnections)) return;
+
+	int32 AdvertisedPort = 0;
+	LastSessionSettings->Get(SETTING_BEACONPORT, AdvertisedPort);
+
+	if (AdvertisedPort != BeaconHost->GetListenPort())
+	{
+		/** the beacon came back on a different port, let party leaders know */
+		LastSessionSettings->Set(SETTING_BEACONPORT, BeaconHost->GetListenPort(), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+		SessionInterface->UpdateSession(NAME_GameSession, *LastSessionSettings);
+	}
+}
+#pragma endregion On Post Load Map
+
+#pragma region On Player Login
+/**
+ * Called before a player is let in, turns away players without a reservation
+ * when the remaining connections are all held for party members.
+ * @param GameMode - The GameMode the player is joining.
+ * @param NewPlayer - The player asking to join.
+ * @param ErrorMessage - Set to reject the player.
+ */
+void USessionsSubsystem::OnPlayerPreLogin(AGameModeBase* GameMode, const FUniqueNetIdRepl& NewPlayer, FString& ErrorMessage)
+{
+	if (!PartyBeaconHost || !GameMode || GameMode->GetWorld() != PartyBeaconHost->GetWorld() || !SessionInterface.IsValid()) return;
+	if (NewPlayer.IsValid() && PartyBeaconHost->PlayerHasReservation(*NewPlayer)) return;
+
+	const FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
+	if (!Session) return;
+
+	if (GetOccupiedConnections(*Session) >= Session->SessionSettings.NumPublicConnections)
+		ErrorMessage = TEXT("Server full, the remaining slots are reserved.");
+}
+
+/**
+ * Called after a player joined, a party member arriving no longer holds a slot.
+ * @param GameMode - The GameMode the player joined.
+ * @param NewPlayer - The Controller of the player that joined.
+ */
+void USessionsSubsystem::OnPlayerPostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer)
+{
+	if (PartyBeaconHost && GameMode && GameMode->GetWorld() == PartyBeaconHost->GetWorld())
+		UpdateReservedSlots();
+}
+#pragma endregion On Player Login
+
+#pragma region On Player Logout
+/**
+ * Called when a player leaves, frees their reservation so another party can take the slot.
+ * @param GameMode - The GameMode the player left.
+ * @param Exiting - The Controller of the player that left.
+ */
+void USessionsSubsystem::OnPlayerLogout(AGameModeBase* GameMode, AController* Exiting)
+{
+	if (!PartyBeaconHost || !GameMode || !Exiting || GameMode->GetWorld() != PartyBeaconHost->GetWorld()) return;
+
+	if (const APlayerState* PlayerState = Exiting->GetPlayerState<APlayerState>())
+		PartyBeaconHost->HandlePlayerLogout(PlayerState->GetUniqueId());
+
+	UpdateReservedSlots();
+}
+#pragma endregion On Player Logout
+
+#pragma region On Network Failure
+/**
+ * Called when a connection failed. Losing the host of a session that allows rehosting starts a rehost,
+ * failing to reach a successor counts as a failed rehost attempt.
+ * @param World - The World the connection belonged to.
+ * @param NetDriver - The NetDriver that failed.
+ * @param FailureType - The kind of failure.
+ * @param ErrorString - A description of the failure.
+ */
+void USessionsSubsystem::OnNetworkFailure(UWorld* World, UNetDriver* NetDriver, const ENetworkFailure::Type FailureType, const FString& ErrorString)
+{
+	if (World && World->GetGameInstance() != GetGameInstance()) return;
+
+	/** beacon connections are not our game connection */
+	if (!NetDriver || (NetDriver->NetDriverName != NAME_GameNetDriver && NetDriver->NetDriverName != NAME_PendingNetDriver)) return;
+
+	if (RehostState == ERehostState::ERS_Joining)
+	{
+		FailRehostAttempt(false);
+		return;
+	}
+
+	if (!World || World->GetNetMode() != NM_Client) return;
+	if (FailureType != ENetworkFailure::ConnectionLost && FailureType != ENetworkFailure::ConnectionTimeout) return;
+
+	if (RehostState == ERehostState::ERS_Watching)
+	{
+		/** our host settled late and is likely handing us over to an earlier successor, walk the list we rehosted with again */
+		RehostSuccessors = WatchedSuccessors;
+		RehostState = ERehostState::ERS_Pending;
+		RehostCandidate = 0;
+		RehostCandidateStartTime = FPlatformTime::Seconds();
+
+		GetGameInstance()->GetTimerManager().SetTimer(RehostTimerHandle, this, &ThisClass::ContinueRehost, RehostRetryDelay, false);
+		return;
+	}
+
+	if (RehostState != ERehostState::ERS_None) return;
+	if (RehostSuccessors.Num() == 0 || !LastSessionSettings.IsValid()) return;
+
+	bool bAllowRehost = false;
+	if (!LastSessionSettings->Get(FName("Rehost"), bAllowRehost) || !bAllowRehost) return;
+
+	/** on the NULL subsystem we may have rejoined by address alone, the successor list is all we need there */
+	const FNamedOnlineSession* Session = SessionInterface.IsValid() ? SessionInterface->GetNamedSession(NAME_GameSession) : nullptr;
+	if (!Session && IOnlineSubsystem::Get()->GetSubsystemName() != "NULL") return;
+
+	/** the engine sends us back to the default map, we pick things up from there */
+	RehostKey = Session ? Session->GetSessionIdStr() : FString();
+	RehostMapPath = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+	RehostState = ERehostState::ERS_Pending;
+	RehostCandidate = 0;
+	RehostCandidateStartTime = FPlatformTime::Seconds();
+
+	GetGameInstance()->GetTimerManager().SetTimer(RehostTimerHandle, this, &ThisClass::ContinueRehost, RehostRetryDelay, false);
+}
+
+/**
+ * Called when a travel failed. Failing to reach a successor counts as a failed rehost attempt,
+ * failing to open the map as the new host ends the rehost.
+ * @param World - The World we tried to travel from.
+ * @param FailureType - The kind of failure.
+ * @param ErrorString - A description of the failure.
+ */
+void USessionsSubsystem::OnTravelFailure(UWorld* World, const ETravelFailure::Type FailureType, const FString& ErrorString)
+{
+	if (World && World->GetGameInstance() != GetGameInstance()) return;
+
+	if (RehostState == ERehostState::ERS_Joining)
+		FailRehostAttempt(false);
+
+	if (RehostState == ERehostState::ERS_Hosting)
+	{
+		/** nobody can reach a session we aren't listening for */
+		FinishRehost(false);
+		DestroySession();
+	}
+}
+#pragma endregion On Network Failure
+
+#pragma endregion World Delegates
\ No newline at end of file
@@ -19,6 +19,7 @@ class SESSIONS_API UMenu : public UUserWidget
 	FString PathToLobby{ FString(TEXT("/Game/Maps/Lobby")) };
 	FString PathToGame{ FString(TEXT("/Game/Maps/Game")) };
 	EMatchType MatchType { EMatchType::EMT_FFA };
+	bool bAllowRehost{ false };
 
 	UPROPERTY()
 	USessionsSubsystem* SessionsSubsystem;
@@ -55,5 +56,5 @@ protected:
 
 public:
 	UFUNCTION(BlueprintCallable)
-	void Setup(int32 Connections = 4, EMatchType TypeOfMatch = EMatchType::EMT_FFA, FString LobbyPath = FString(TEXT("/Game/ThirdPerson/Maps/Lobby")));
+	void Setup(int32 Connections = 4, EMatchType TypeOfMatch = EMatchType::EMT_FFA, FString LobbyPath = FString(TEXT("/Game/ThirdPerson/Maps/Lobby")), bool bRehost = false);
 };
\ No newline at end of file
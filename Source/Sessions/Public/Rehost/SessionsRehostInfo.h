@@ -0,0 +1,47 @@
+// kata.codes
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/OnlineReplStructs.h"
+#include "SessionsRehostInfo.generated.h"
+
+/** A player that can take over hosting the session. */
+USTRUCT()
+struct FSessionsSuccessor
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FUniqueNetIdRepl PlayerId;
+
+	/** the player's address as seen by the host, only filled on the NULL subsystem where it is used to rejoin */
+	UPROPERTY()
+	FString Address;
+
+	/** the port the player listens on once it takes over, only filled on the NULL subsystem */
+	UPROPERTY()
+	int32 Port{ 0 };
+};
+
+/**
+ * Replicates the host's ranked successor list to every client of a listen server session.
+ */
+UCLASS(NotPlaceable)
+class SESSIONS_API ASessionsRehostInfo : public AInfo
+{
+	GENERATED_BODY()
+
+	UFUNCTION()
+	void OnRep_Successors();
+
+protected:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+public:
+	ASessionsRehostInfo();
+
+	/** best connection first */
+	UPROPERTY(ReplicatedUsing = OnRep_Successors)
+	TArray<FSessionsSuccessor> Successors;
+};
\ No newline at end of file
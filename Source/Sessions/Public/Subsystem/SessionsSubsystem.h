@@ -2,8 +2,12 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/EngineTypes.h"
 #include "Helper/Enums.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "PartyBeaconState.h"
+#include "Rehost/SessionsRehostInfo.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "SessionsSubsystem.generated.h"
 
@@ -12,6 +16,16 @@ DECLARE_MULTICAST_DELEGATE_TwoParams(FSessionsOnFindSessionsComplete, const TArr
 DECLARE_MULTICAST_DELEGATE_OneParam(FSessionsOnJoinSessionComplete, EOnJoinSessionCompleteResult::Type Result);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FSessionsOnDestroySessionComplete, bool, bWasSuccessful);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FSessionsOnStartSessionComplete, bool, bWasSuccessful);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FSessionsOnRehostSessionComplete, bool, bWasSuccessful);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FSessionsOnReservePartySlotsComplete, const FOnlineSessionSearchResult& SessionResult, const FString& ConnectString, EPartyReservationResult::Type Result);
+
+class AController;
+class AGameModeBase;
+class AOnlineBeaconHost;
+class APlayerController;
+class APartyBeaconClient;
+class APartyBeaconHost;
+class UNetDriver;
 
 UCLASS()
 class SESSIONS_API USessionsSubsystem : public UGameInstanceSubsystem
@@ -27,16 +41,89 @@ class SESSIONS_API USessionsSubsystem : public UGameInstanceSubsystem
 	FOnJoinSessionCompleteDelegate JoinSessionCompleteDelegate;
 	FOnStartSessionCompleteDelegate StartSessionCompleteDelegate;
 	FOnDestroySessionCompleteDelegate DestroySessionCompleteDelegate;
+	FOnFindSessionsCompleteDelegate RehostSearchCompleteDelegate;
+	FOnFindFriendSessionCompleteDelegate FindFriendSessionCompleteDelegate;
 
 	FDelegateHandle CreateSessionCompleteDelegateHandle;
 	FDelegateHandle FindSessionsCompleteDelegateHandle;
 	FDelegateHandle JoinSessionCompleteDelegateHandle;
 	FDelegateHandle StartSessionCompleteDelegateHandle;
 	FDelegateHandle DestroySessionCompleteDelegateHandle;
+	FDelegateHandle RehostSearchCompleteDelegateHandle;
+	FDelegateHandle FindFriendSessionCompleteDelegateHandle;
+
+	/** host side: accepts party slot reservations for our session */
+	UPROPERTY()
+	AOnlineBeaconHost* BeaconHost;
+
+	UPROPERTY()
+	APartyBeaconHost* PartyBeaconHost;
+
+	/** host side: outstanding reservations, kept alive while the beacon is rebuilt across map travel */
+	UPROPERTY()
+	UPartyBeaconState* PartyBeaconState;
+
+	/** party leader side: the in-flight reservation request */
+	UPROPERTY()
+	APartyBeaconClient* PartyBeaconClient;
+
+	FOnlineSessionSearchResult LastReservedSession;
+
+	FDelegateHandle WorldCleanupDelegateHandle;
+	FDelegateHandle PostLoadMapDelegateHandle;
+	FDelegateHandle PreLoginDelegateHandle;
+	FDelegateHandle PostLoginDelegateHandle;
+	FDelegateHandle LogoutDelegateHandle;
+	FDelegateHandle NetworkFailureDelegateHandle;
+	FDelegateHandle TravelFailureDelegateHandle;
+
+	/** host side: replicates the successor list to our clients */
+	UPROPERTY()
+	ASessionsRehostInfo* RehostInfo;
+
+	/** client side: the last successor list we received, best connection first */
+	TArray<FSessionsSuccessor> RehostSuccessors;
+	/** the successor list we rehosted with, kept while an earlier successor may still come up */
+	TArray<FSessionsSuccessor> WatchedSuccessors;
+	TSharedPtr<FOnlineSessionSearch> RehostSearch;
+	FString RehostMapPath;
+	/** the departed session's id, a recreated session advertises it so clients can find it */
+	FString RehostKey;
+	ERehostState RehostState{ ERehostState::ERS_None };
+	int32 RehostCandidate{ 0 };
+	double RehostCandidateStartTime{ 0. };
+	/** time a successor gets to load the default map, recreate the session and travel back, before we move on */
+	float RehostCandidateTimeout{ 30.f };
+	float RehostRetryDelay{ 1.f };
+	float RehostWatchInterval{ 5.f };
+	float RankSuccessorsInterval{ 2.f };
+	FTimerHandle RehostTimerHandle;
+	FTimerHandle RankSuccessorsTimerHandle;
 
 	bool bCreateSessionOnDestroy{ false };
 	int32 LastNumberOfConnections{ 4 };
 	EMatchType LastMatchType{ EMatchType::EMT_FFA };
+	bool bLastAllowRehost{ false };
+
+	bool ClaimSessionSearch();
+
+	bool StartPartyBeacon(int32 NumPublicConnections);
+	void StopPartyBeacon();
+	int32 GetOccupiedConnections(const FNamedOnlineSession& Session) const;
+	int32 GetHeldReservations(const FNamedOnlineSession& Session) const;
+	void UpdateReservedSlots();
+
+	void StartRehostInfo(UWorld* World);
+	void RankSuccessors();
+	void ContinueRehost();
+	void HostRehostedSession();
+	bool StartRehostSearch();
+	void SearchRehostedSession();
+	void TravelToRehostedSession();
+	void FailRehostAttempt(bool bSkipCandidate);
+	void FinishRehost(bool bWasSuccessful);
+	void WatchRehost();
+	void StopWatchingRehost();
 
 protected:
 	void OnCreateSessionComplete(FName SessionName, bool bWasSuccessful);
@@ -44,19 +131,41 @@ protected:
 	void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
 	void OnStartSessionComplete(FName SessionName, bool bWasSuccessful);
 	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful);
+	void OnFindFriendSessionComplete(int32 LocalUserNum, bool bWasSuccessful, const TArray<FOnlineSessionSearchResult>& FriendSearchResults);
+	void OnRehostSearchComplete(bool bWasSuccessful);
+
+	void OnPartyReservationComplete(EPartyReservationResult::Type Result);
+	void OnPartyBeaconHostConnectionFailure();
+	bool OnValidatePartyReservation(const TArray<FPlayerReservation>& PartyMembers) const;
+
+	void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+	void OnPostLoadMap(UWorld* World);
+	void OnPlayerPreLogin(AGameModeBase* GameMode, const FUniqueNetIdRepl& NewPlayer, FString& ErrorMessage);
+	void OnPlayerPostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer);
+	void OnPlayerLogout(AGameModeBase* GameMode, AController* Exiting);
+	void OnNetworkFailure(UWorld* World, UNetDriver* NetDriver, ENetworkFailure::Type FailureType, const FString& ErrorString);
+	void OnTravelFailure(UWorld* World, ETravelFailure::Type FailureType, const FString& ErrorString);
 
 public:
 	USessionsSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
 	
 	FSessionsOnCreateSessionComplete SessionsOnCreateSessionComplete;
 	FSessionsOnFindSessionsComplete SessionsOnFindSessionsComplete;
 	FSessionsOnJoinSessionComplete SessionsOnJoinSessionComplete;
 	FSessionsOnStartSessionComplete SessionsOnStartSessionComplete;
 	FSessionsOnDestroySessionComplete SessionsOnDestroySessionComplete;
+	FSessionsOnReservePartySlotsComplete SessionsOnReservePartySlotsComplete;
+	FSessionsOnRehostSessionComplete SessionsOnRehostSessionComplete;
 
-	void CreateSession(int32 NumPublicConnections, EMatchType MatchType);
+	void CreateSession(int32 NumPublicConnections, EMatchType MatchType, bool bAllowRehost = false);
 	void FindSessions(int32 MaxSearchResults);
 	void JoinSession(const FOnlineSessionSearchResult& SessionResult);
 	void StartSession();
 	void DestroySession();
+	void ReservePartySlots(const FOnlineSessionSearchResult& SessionResult, const TArray<FUniqueNetIdRepl>& PartyMembers);
+	void JoinPartyLeaderSession(const FUniqueNetIdRepl& PartyLeader, const FString& ConnectString);
+	void CacheRehostSuccessors(const TArray<FSessionsSuccessor>& Successors);
 };
\ No newline at end of file
@@ -7,7 +7,7 @@ public class Sessions : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new [] { "Core", "OnlineSubsystem", "OnlineSubsystemSteam" });
-		PrivateDependencyModuleNames.AddRange(new [] { "CoreUObject", "Engine", "UMG", "Slate", "SlateCore" });
+		PublicDependencyModuleNames.AddRange(new [] { "Core", "OnlineSubsystem", "OnlineSubsystemSteam", "OnlineSubsystemUtils" });
+		PrivateDependencyModuleNames.AddRange(new [] { "CoreUObject", "Engine", "Sockets", "UMG", "Slate", "SlateCore" });
 	}
 }
\ No newline at end of file